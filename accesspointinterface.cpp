@@ -0,0 +1,3 @@
+#include "accesspointinterface.hpp"
+
+Q_LOGGING_CATEGORY(accessPointInterfaceCategory, "accessPointInterface")
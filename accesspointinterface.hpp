@@ -0,0 +1,187 @@
+#pragma once
+
+#include "networkmanagerinterface.hpp"
+#include "tracing.hpp"
+
+#include <QtCore>
+#include <QtDBus>
+
+#include <NetworkManager.h>
+#include <dbus/dbus.h>
+
+Q_DECLARE_LOGGING_CATEGORY(accessPointInterfaceCategory)
+
+class AccessPointInterface
+        : public TracedInterface
+{
+
+    Q_OBJECT
+
+    Q_PROPERTY(uint Flags MEMBER Flags NOTIFY FlagsChanged)
+    Q_PROPERTY(uint Frequency MEMBER Frequency NOTIFY FrequencyChanged)
+    Q_PROPERTY(QString HwAddress MEMBER HwAddress NOTIFY HwAddressChanged)
+    Q_PROPERTY(int LastSeen MEMBER LastSeen NOTIFY LastSeenChanged)
+    Q_PROPERTY(uint MaxBitrate MEMBER MaxBitrate NOTIFY MaxBitrateChanged)
+    Q_PROPERTY(uint Mode MEMBER Mode NOTIFY ModeChanged)
+    Q_PROPERTY(uint RsnFlags MEMBER RsnFlags NOTIFY RsnFlagsChanged)
+    Q_PROPERTY(QByteArray Ssid MEMBER Ssid NOTIFY SsidChanged)
+    Q_PROPERTY(uchar Strength MEMBER Strength NOTIFY StrengthChanged)
+    Q_PROPERTY(uint WpaFlags MEMBER WpaFlags NOTIFY WpaFlagsChanged)
+
+public :
+
+    AccessPointInterface(QString const & path,
+                         QDBusConnection const & connection,
+                         QObject * const parent = Q_NULLPTR)
+        : TracedInterface{{NM_DBUS_SERVICE}, path, NM_DBUS_INTERFACE_ACCESS_POINT,
+                          connection,
+                          parent}
+    {
+        if (!this->connection().connect({NM_DBUS_SERVICE}, this->path(), {DBUS_INTERFACE_PROPERTIES}, {"PropertiesChanged"},
+                                        this, SLOT(propertiesChanged(QString, QVariantMap, QStringList)))) {
+            Q_ASSERT(false);
+        }
+    }
+
+    QDBusPendingReply< QVariantMap > GetAll() // all the properties in a single round trip instead of one Get per property
+    {
+        auto message = QDBusMessage::createMethodCall({NM_DBUS_SERVICE}, path(), {DBUS_INTERFACE_PROPERTIES}, {"GetAll"});
+        message << interface();
+        return connection().asyncCall(message, timeout());
+    }
+
+Q_SIGNALS :
+
+    void propertiesUpdated(QVariantMap changedProperties); // deltas as they arrive, to avoid reading them back one by one
+
+private Q_SLOTS :
+
+    void propertyChanged(QString const & propertyName)
+    {
+        const TraceScope traceScope{"propertyChanged", propertyName};
+        const auto signature = QStringLiteral("%1Changed()").arg(propertyName);
+        const int signalIndex = staticMetaObject.indexOfSignal(QMetaObject::normalizedSignature(qUtf8Printable(signature)).constData());
+        if (signalIndex < 0) {
+            qCCritical(accessPointInterfaceCategory).noquote()
+                    << tr("There is no signal with %1 signature")
+                       .arg(signature);
+            return;
+        }
+        const auto signal = staticMetaObject.method(signalIndex);
+        if (!signal.invoke(this, Qt::DirectConnection)) {
+            qCCritical(accessPointInterfaceCategory).noquote()
+                    << tr("Unable to emit %1 signal for %2 property")
+                       .arg(signature,
+                            propertyName);
+        }
+    }
+
+    void propertiesChanged(QString interfaceName, QVariantMap changedProperties, QStringList invalidatedProperties)
+    {
+        const TraceScope traceScope{"PropertiesChanged", interfaceName, path()};
+        if (interfaceName != interface()) {
+            return;
+        }
+        Q_EMIT propertiesUpdated(changedProperties);
+        QMapIterator< QString, QVariant > i{changedProperties};
+        while (i.hasNext()) {
+            i.next();
+            propertyChanged(i.key());
+        }
+        for (QString const & invalidatedProperty : invalidatedProperties) {
+            propertyChanged(invalidatedProperty);
+        }
+    }
+
+Q_SIGNALS :
+
+    void FlagsChanged();
+    void FrequencyChanged();
+    void HwAddressChanged();
+    void LastSeenChanged();
+    void MaxBitrateChanged();
+    void ModeChanged();
+    void RsnFlagsChanged();
+    void SsidChanged();
+    void StrengthChanged();
+    void WpaFlagsChanged();
+
+private :
+
+    Q_DISABLE_COPY(AccessPointInterface)
+
+    uint Flags;
+    uint Frequency;
+    QString HwAddress;
+    int LastSeen;
+    uint MaxBitrate;
+    uint Mode;
+    uint RsnFlags;
+    QByteArray Ssid;
+    uchar Strength;
+    uint WpaFlags;
+
+};
+
+class DeviceInterface
+        : public TracedInterface
+{
+
+    Q_OBJECT
+
+public :
+
+    DeviceInterface(QString const & path,
+                    QDBusConnection const & connection,
+                    QObject * const parent = Q_NULLPTR)
+        : TracedInterface{{NM_DBUS_SERVICE}, path, NM_DBUS_INTERFACE_DEVICE,
+                          connection,
+                          parent}
+    { ; }
+
+    QDBusPendingReply< QDBusVariant > Get(QString const & propertyName)
+    {
+        auto message = QDBusMessage::createMethodCall({NM_DBUS_SERVICE}, path(), {DBUS_INTERFACE_PROPERTIES}, {"Get"});
+        message << interface() << propertyName;
+        return connection().asyncCall(message, timeout());
+    }
+
+private :
+
+    Q_DISABLE_COPY(DeviceInterface)
+
+};
+
+class WirelessDeviceInterface
+        : public TracedInterface
+{
+
+    Q_OBJECT
+
+public :
+
+    WirelessDeviceInterface(QString const & path,
+                            QDBusConnection const & connection,
+                            QObject * const parent = Q_NULLPTR)
+        : TracedInterface{{NM_DBUS_SERVICE}, path, NM_DBUS_INTERFACE_DEVICE_WIRELESS,
+                          connection,
+                          parent}
+    {
+        qDBusRegisterMetaType< NMObjectPathsList >();
+    }
+
+    QDBusPendingReply< NMObjectPathsList > GetAllAccessPoints()
+    {
+        return asyncCall(QStringLiteral("GetAllAccessPoints"));
+    }
+
+Q_SIGNALS :
+
+    Q_SCRIPTABLE void AccessPointAdded(QDBusObjectPath);
+    Q_SCRIPTABLE void AccessPointRemoved(QDBusObjectPath);
+
+private :
+
+    Q_DISABLE_COPY(WirelessDeviceInterface)
+
+};
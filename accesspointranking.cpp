@@ -0,0 +1,3 @@
+#include "accesspointranking.hpp"
+
+Q_LOGGING_CATEGORY(accessPointRankingCategory, "accessPointRanking")
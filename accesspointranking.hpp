@@ -0,0 +1,404 @@
+#pragma once
+
+#include "accesspointinterface.hpp"
+
+#include <QtCore>
+#include <QtDBus>
+
+#include <NetworkManager.h>
+
+#include <functional>
+#include <utility>
+
+Q_DECLARE_LOGGING_CATEGORY(accessPointRankingCategory)
+
+template< typename Key, typename Priority, typename Compare = std::less< Priority > >
+class IndexedHeap // binary max-heap with a key -> position index, so that any entry can be updated or erased in O(log n)
+{
+
+public :
+
+    bool isEmpty() const
+    {
+        return heap.isEmpty();
+    }
+
+    int size() const
+    {
+        return heap.size();
+    }
+
+    bool contains(Key const & key) const
+    {
+        return positions.contains(key);
+    }
+
+    Key const & top() const
+    {
+        Q_ASSERT(!isEmpty());
+        return heap.first().first;
+    }
+
+    Priority const & priority(Key const & key) const
+    {
+        Q_ASSERT(contains(key));
+        return heap.at(positions.value(key)).second;
+    }
+
+    void insertOrUpdate(Key const & key, Priority priority)
+    {
+        const auto position = positions.constFind(key);
+        if (position == positions.cend()) {
+            heap.append({key, std::move(priority)});
+            positions.insert(key, heap.size() - 1);
+            siftUp(heap.size() - 1);
+            return;
+        }
+        const int index = position.value();
+        const bool increased = compare(heap.at(index).second, priority);
+        heap[index].second = std::move(priority);
+        if (increased) {
+            siftUp(index);
+        } else {
+            siftDown(index);
+        }
+    }
+
+    bool remove(Key const & key)
+    {
+        const auto position = positions.constFind(key);
+        if (position == positions.cend()) {
+            return false;
+        }
+        const int index = position.value();
+        const int last = heap.size() - 1;
+        if (index != last) {
+            swap(index, last);
+        }
+        positions.remove(key);
+        heap.removeLast();
+        if (index != last) {
+            siftDown(siftUp(index));
+        }
+        return true;
+    }
+
+private :
+
+    QVector< QPair< Key, Priority > > heap;
+    QHash< Key, int > positions;
+    Compare compare;
+
+    void swap(int lhs, int rhs)
+    {
+        std::swap(heap[lhs], heap[rhs]);
+        positions[heap.at(lhs).first] = lhs;
+        positions[heap.at(rhs).first] = rhs;
+    }
+
+    int siftUp(int index)
+    {
+        while (index > 0) {
+            const int parent = (index - 1) / 2;
+            if (!compare(heap.at(parent).second, heap.at(index).second)) {
+                break;
+            }
+            swap(parent, index);
+            index = parent;
+        }
+        return index;
+    }
+
+    void siftDown(int index)
+    {
+        for (;;) {
+            int largest = index;
+            for (const int child : {2 * index + 1, 2 * index + 2}) {
+                if ((child < heap.size()) && compare(heap.at(largest).second, heap.at(child).second)) {
+                    largest = child;
+                }
+            }
+            if (largest == index) {
+                break;
+            }
+            swap(index, largest);
+            index = largest;
+        }
+    }
+
+};
+
+class AccessPointRanking // keeps the best access point per SSID up to date from property deltas
+        : public QObject
+{
+
+    Q_OBJECT
+
+public :
+
+    static constexpr int band5GHzBonus = 10; // 5 GHz band is usually less congested
+    static constexpr int openPenalty = 50; // addConnection configures wpa-psk, open networks are last resort
+
+    AccessPointRanking(QDBusConnection const & connection,
+                       int hysteresis,
+                       QObject * const parent = Q_NULLPTR)
+        : QObject{parent}
+        , connection{connection}
+        , hysteresis{hysteresis}
+    { ; }
+
+    QString bestAccessPoint(QByteArray const & ssid) const
+    {
+        return candidates.value(ssid).selected;
+    }
+
+    QString device(QString const & accessPoint) const
+    {
+        return accessPoints.value(accessPoint).device;
+    }
+
+public Q_SLOTS :
+
+    void addDevice(QDBusObjectPath const & device) // replies arrive asynchronously, so that hundreds of access points do not block GUI
+    {
+        const QString path = device.path();
+        if (devices.contains(path) || pendingDevices.contains(path)) {
+            return;
+        }
+        const auto deviceInterface = ::new DeviceInterface{path, connection, this};
+        pendingDevices.insert(path, deviceInterface);
+        const auto watcher = ::new QDBusPendingCallWatcher{deviceInterface->Get(QStringLiteral("DeviceType")), deviceInterface};
+        connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, path, deviceInterface] (QDBusPendingCallWatcher * const watcher)
+        {
+            watcher->deleteLater();
+            if (pendingDevices.value(path) != deviceInterface) { // removed while the reply was in flight
+                return;
+            }
+            pendingDevices.remove(path);
+            deviceInterface->deleteLater();
+            QDBusPendingReply< QDBusVariant > pendingReply = *watcher;
+            if (pendingReply.isError()) {
+                qCWarning(accessPointRankingCategory).noquote()
+                        << tr("Asynchronous call finished with error: %1")
+                           .arg(pendingReply.error().message());
+                return;
+            }
+            if (pendingReply.value().variant().toUInt() == NM_DEVICE_TYPE_WIFI) {
+                addWirelessDevice(path);
+            }
+        });
+    }
+
+    void removeDevice(QDBusObjectPath const & device)
+    {
+        const QString path = device.path();
+        if (const auto deviceInterface = pendingDevices.take(path)) {
+            deviceInterface->deleteLater();
+        }
+        const auto wirelessDevice = devices.take(path);
+        if (!wirelessDevice) {
+            return;
+        }
+        for (QString const & accessPoint : accessPoints.keys()) {
+            if (accessPoints.value(accessPoint).device == path) {
+                removeAccessPoint(accessPoint);
+            }
+        }
+        wirelessDevice->deleteLater();
+    }
+
+Q_SIGNALS :
+
+    void bestAccessPointChanged(QByteArray ssid, QString accessPoint);
+
+private :
+
+    Q_DISABLE_COPY(AccessPointRanking)
+
+    struct AccessPoint
+    {
+        QString device;
+        AccessPointInterface * accessPointInterface = Q_NULLPTR;
+        QByteArray ssid;
+        uint flags = 0;
+        uint frequency = 0;
+        uchar strength = 0;
+    };
+
+    struct Candidates
+    {
+        IndexedHeap< QString, int > heap;
+        QString selected;
+    };
+
+    QDBusConnection connection;
+    const int hysteresis;
+
+    QHash< QString, DeviceInterface * > pendingDevices; // device type is not known yet
+    QHash< QString, WirelessDeviceInterface * > devices;
+    QHash< QString, AccessPoint > accessPoints;
+    QHash< QByteArray, Candidates > candidates;
+
+    static int score(AccessPoint const & accessPoint)
+    {
+        int score = accessPoint.strength;
+        if (accessPoint.frequency > 4900) {
+            score += band5GHzBonus;
+        }
+        if ((accessPoint.flags & NM_802_11_AP_FLAGS_PRIVACY) == 0) {
+            score -= openPenalty;
+        }
+        return score;
+    }
+
+    void addWirelessDevice(QString const & path)
+    {
+        const auto wirelessDevice = ::new WirelessDeviceInterface{path, connection, this};
+        devices.insert(path, wirelessDevice);
+        connect(wirelessDevice, &WirelessDeviceInterface::AccessPointAdded, this, [this, path] (QDBusObjectPath const & accessPoint)
+        {
+            addAccessPoint(path, accessPoint.path());
+        });
+        connect(wirelessDevice, &WirelessDeviceInterface::AccessPointRemoved, this, [this] (QDBusObjectPath const & accessPoint)
+        {
+            removeAccessPoint(accessPoint.path());
+        });
+        const auto watcher = ::new QDBusPendingCallWatcher{wirelessDevice->GetAllAccessPoints(), wirelessDevice};
+        connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, path, wirelessDevice] (QDBusPendingCallWatcher * const watcher)
+        {
+            watcher->deleteLater();
+            if (devices.value(path) != wirelessDevice) { // removed while the reply was in flight
+                return;
+            }
+            QDBusPendingReply< NMObjectPathsList > pendingReply = *watcher;
+            if (pendingReply.isError()) {
+                qCWarning(accessPointRankingCategory).noquote()
+                        << tr("Asynchronous call finished with error: %1")
+                           .arg(pendingReply.error().message());
+                return;
+            }
+            for (QDBusObjectPath const & accessPoint : pendingReply.value()) {
+                addAccessPoint(path, accessPoint.path());
+            }
+        });
+    }
+
+    void addAccessPoint(QString const & device, QString const & path)
+    {
+        if (accessPoints.contains(path)) {
+            return;
+        }
+        const auto accessPointInterface = ::new AccessPointInterface{path, connection, this};
+        connect(accessPointInterface, &AccessPointInterface::propertiesUpdated, this, [this, path] (QVariantMap const & changedProperties)
+        {
+            updateAccessPoint(path, changedProperties);
+        });
+        auto & accessPoint = accessPoints[path];
+        accessPoint.device = device;
+        accessPoint.accessPointInterface = accessPointInterface;
+        const auto watcher = ::new QDBusPendingCallWatcher{accessPointInterface->GetAll(), accessPointInterface};
+        connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, path, accessPointInterface] (QDBusPendingCallWatcher * const watcher)
+        {
+            watcher->deleteLater();
+            if (accessPoints.value(path).accessPointInterface != accessPointInterface) { // removed while the reply was in flight
+                return;
+            }
+            QDBusPendingReply< QVariantMap > pendingReply = *watcher;
+            if (pendingReply.isError()) {
+                qCWarning(accessPointRankingCategory).noquote()
+                        << tr("Asynchronous call finished with error: %1")
+                           .arg(pendingReply.error().message());
+                return;
+            }
+            updateAccessPoint(path, pendingReply.value()); // not ranked until the first snapshot of properties arrives
+        });
+    }
+
+    void removeAccessPoint(QString const & path)
+    {
+        const auto accessPoint = accessPoints.take(path);
+        if (!accessPoint.accessPointInterface) {
+            return;
+        }
+        accessPoint.accessPointInterface->deleteLater();
+        withdraw(accessPoint.ssid, path);
+    }
+
+    void updateAccessPoint(QString const & path, QVariantMap const & changedProperties)
+    {
+        const auto it = accessPoints.find(path);
+        if (it == accessPoints.end()) {
+            return;
+        }
+        auto & accessPoint = it.value();
+        const QByteArray ssid = accessPoint.ssid;
+        const auto end = changedProperties.cend();
+        auto property = changedProperties.constFind(QStringLiteral("Ssid"));
+        if (property != end) {
+            accessPoint.ssid = property.value().toByteArray();
+        }
+        property = changedProperties.constFind(QStringLiteral("Strength"));
+        if (property != end) {
+            accessPoint.strength = property.value().value< uchar >();
+        }
+        property = changedProperties.constFind(QStringLiteral("Frequency"));
+        if (property != end) {
+            accessPoint.frequency = property.value().toUInt();
+        }
+        property = changedProperties.constFind(QStringLiteral("Flags"));
+        if (property != end) {
+            accessPoint.flags = property.value().toUInt();
+        }
+        if (ssid != accessPoint.ssid) {
+            withdraw(ssid, path);
+        }
+        if (accessPoint.ssid.isEmpty()) { // hidden network
+            return;
+        }
+        auto & ssidCandidates = candidates[accessPoint.ssid];
+        const bool entering = !ssidCandidates.heap.contains(path);
+        ssidCandidates.heap.insertOrUpdate(path, score(accessPoint));
+        reselect(accessPoint.ssid, ssidCandidates, entering ? path : QString{});
+    }
+
+    void withdraw(QByteArray const & ssid, QString const & path)
+    {
+        const auto it = candidates.find(ssid);
+        if (it == candidates.end()) {
+            return;
+        }
+        auto & ssidCandidates = it.value();
+        if (!ssidCandidates.heap.remove(path)) {
+            return;
+        }
+        if (ssidCandidates.selected == path) {
+            ssidCandidates.selected.clear();
+        }
+        if (ssidCandidates.heap.isEmpty()) {
+            candidates.erase(it);
+            Q_EMIT bestAccessPointChanged(ssid, {});
+            return;
+        }
+        reselect(ssid, ssidCandidates);
+    }
+
+    void reselect(QByteArray const & ssid, Candidates & ssidCandidates, QString const & newcomer = {})
+    {
+        QString const & top = ssidCandidates.heap.top();
+        if (top == ssidCandidates.selected) {
+            return;
+        }
+        if (!ssidCandidates.selected.isEmpty() && (top != newcomer)) { // first snapshot competes on score alone, otherwise startup choice depends on reply order
+            const int selectedScore = ssidCandidates.heap.priority(ssidCandidates.selected);
+            if (ssidCandidates.heap.priority(top) < selectedScore + hysteresis) { // avoid flapping between comparable access points
+                return;
+            }
+        }
+        ssidCandidates.selected = top;
+        qCDebug(accessPointRankingCategory).noquote()
+                << tr("Access point %1 is the best for SSID %2")
+                   .arg(top, QString::fromUtf8(ssid));
+        Q_EMIT bestAccessPointChanged(ssid, top);
+    }
+
+};
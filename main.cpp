@@ -58,6 +58,8 @@ int main(int argc, char * argv [])
 
     loadTranslations(networkManagerCategory());
 
+    Tracer::start();
+
     {
         QFont font = application.font();
         font.setPointSize(QSettings{}.value("fontSize", 24).toInt(&ok));
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "accesspointranking.hpp"
 #include "networkmanagerinterface.hpp"
 
 #include <QtCore>
@@ -43,6 +44,7 @@ inline
 QByteArray
 WPA_PSK(QByteArray secret, QByteArray salt) // why WPA? https://wigle.net/stats#
 {
+    const TraceScope traceScope{"PBKDF2", "WPA_PSK"};
     QByteArray result{32, Qt::Uninitialized};
     PKCS5_PBKDF2_HMAC_SHA1(secret.constData(), secret.length(), auto_ptr_cast(salt.constData()), salt.length(), 4096, result.length(), auto_ptr_cast(result.data()));
     return result;
@@ -76,6 +78,7 @@ public :
                    QObject * const parent)
         : QObject{parent}
         , networkManagerInterface{connection}
+        , accessPointRanking{connection, QSettings{}.value("roamingHysteresis", 8).toInt()}
     {
         Q_CHECK_PTR(parent);
         if (!networkManagerInterface.isValid()) {
@@ -84,16 +87,63 @@ public :
         }
         connect(&networkManagerInterface, &NetworkManagerInterface::VersionChanged,
                 this, &NetworkManager::versionChanged); // lowercase capitalized first letter of signal name
+        connect(&accessPointRanking, &AccessPointRanking::bestAccessPointChanged, this, [this] (QByteArray const & ssid, QString const & accessPoint)
+        {
+            Q_EMIT bestAccessPointChanged(QString::fromUtf8(ssid), accessPoint);
+        });
+        connect(&networkManagerInterface, &NetworkManagerInterface::DeviceAdded,
+                &accessPointRanking, &AccessPointRanking::addDevice);
+        connect(&networkManagerInterface, &NetworkManagerInterface::DeviceRemoved,
+                &accessPointRanking, &AccessPointRanking::removeDevice);
+        const auto watcher = ::new QDBusPendingCallWatcher{networkManagerInterface.asyncCall(QStringLiteral("GetDevices")), this};
+        connect(watcher, &QDBusPendingCallWatcher::finished, this, [this] (QDBusPendingCallWatcher * const watcher)
+        {
+            watcher->deleteLater();
+            QDBusPendingReply< NMObjectPathsList > pendingReply = *watcher;
+            if (pendingReply.isError()) {
+                qCWarning(networkManagerCategory).noquote()
+                        << tr("Asynchronous call finished with error: %1")
+                           .arg(pendingReply.error().message());
+                return;
+            }
+            for (QDBusObjectPath const & device : pendingReply.value()) {
+                accessPointRanking.addDevice(device);
+            }
+        });
     }
 
     QString version() const
     {
-        return networkManagerInterface.property("Version").toString();
+        return networkManagerInterface.tracedProperty("Version").toString();
     }
 
     Q_INVOKABLE
-    QString addConnection(QString device, QString accessPoint, QString ssid, QString psk, bool hashed = false)
+    QString bestAccessPoint(QString ssid) const
     {
+        return accessPointRanking.bestAccessPoint(ssid.toUtf8());
+    }
+
+    Q_INVOKABLE
+    QString addConnection(QString device, QString accessPoint, QString ssid, QString psk, bool hashed = false) // empty device and accessPoint are chosen by ranking
+    {
+        if (accessPoint.isEmpty()) {
+            accessPoint = bestAccessPoint(ssid);
+            if (accessPoint.isEmpty()) {
+                qCWarning(networkManagerCategory).noquote()
+                        << tr("There is no access point for SSID %1")
+                           .arg(ssid);
+                return {};
+            }
+        }
+        if (device.isEmpty()) {
+            device = accessPointRanking.device(accessPoint);
+            if (device.isEmpty()) {
+                qCWarning(networkManagerCategory).noquote()
+                        << tr("There is no device for access point %1")
+                           .arg(accessPoint);
+                return {};
+            }
+        }
         return networkManagerInterface.AddAndActivateConnection(MakeWirelessConnectionParameters(psk.toUtf8(), ssid.toUtf8(), hashed),
                                                                 QDBusObjectPath{device},
                                                                 QDBusObjectPath{accessPoint},
@@ -103,12 +153,14 @@ public :
 Q_SIGNALS :
 
     void versionChanged();
+    void bestAccessPointChanged(QString ssid, QString accessPoint);
 
 private :
 
     Q_DISABLE_COPY(NetworkManager)
 
     NetworkManagerInterface networkManagerInterface;
+    AccessPointRanking accessPointRanking;
 
     QDBusObjectPath activatingConnection;
 
@@ -137,6 +189,7 @@ public :
         const auto onRegistration = [&] (QString const & serviceName)
         {
             Q_ASSERT(serviceName == NM_DBUS_SERVICE);
+            const TraceScope traceScope{"service", "registered"};
             qCInfo(networkManagerCategory).noquote()
                     << tr("Service %1 is registered")
                        .arg(serviceName);
@@ -150,6 +203,7 @@ public :
         const auto onUnregistration = [&] (QString const & serviceName)
         {
             Q_ASSERT(serviceName == NM_DBUS_SERVICE);
+            const TraceScope traceScope{"service", "unregistered"};
             qCInfo(networkManagerCategory).noquote()
                     << tr("Service %1 is unregistered")
                        .arg(serviceName);
@@ -159,7 +213,13 @@ public :
         //connect(dbus, &QDBusConnectionInterface::serviceUnregistered, this, onUnregistration); // not works as expected
         connect(&serviceUnregistrationWatcher, &QDBusServiceWatcher::serviceUnregistered, this, onUnregistration);
 
-        if (dbus->isServiceRegistered(QStringLiteral(NM_DBUS_SERVICE))) {
+        const bool isServiceRegistered = [&]
+        {
+            const TraceScope traceScope{"call", "NameHasOwner"};
+            return dbus->isServiceRegistered(QStringLiteral(NM_DBUS_SERVICE)).value();
+        }();
+        if (isServiceRegistered) {
+            const TraceScope traceScope{"service", "registered"};
             createNetworkManager();
         }
 
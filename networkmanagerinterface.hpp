@@ -1,5 +1,7 @@
 #pragma once
 
+#include "tracing.hpp"
+
 #include <QtCore>
 #include <QtDBus>
 
@@ -7,6 +9,8 @@
 #include <dbus/dbus.h>
 #include <glib.h>
 
+#include <utility>
+
 Q_DECLARE_LOGGING_CATEGORY(networkManagerInterfaceCategory)
 
 using NMObjectPathsList = QList< QDBusObjectPath >;
@@ -53,10 +57,39 @@ operator >> (QDBusArgument const & argument, NMStringMap & stringMap)
     return argument;
 }
 
-class NetworkManagerInterface
+class TracedInterface // base of all the proxies: blocking call()s go through trace scopes
         : public QDBusAbstractInterface
 {
 
+public :
+
+    template< typename ...Arguments >
+    QDBusMessage call(QDBus::CallMode mode, QString const & method, Arguments &&... arguments) // hides QDBusAbstractInterface::call
+    {
+        const TraceScope traceScope{"call", method};
+        return QDBusAbstractInterface::call(mode, method, std::forward< Arguments >(arguments)...);
+    }
+
+    QVariant tracedProperty(char const * name) const // property() is a blocking Properties.Get for D-Bus properties, reads through meta-object (e.g. QML) are not traced
+    {
+        const TraceScope traceScope{"Get", name};
+        return QDBusAbstractInterface::property(name);
+    }
+
+protected :
+
+    using QDBusAbstractInterface::QDBusAbstractInterface;
+
+private :
+
+    Q_DISABLE_COPY(TracedInterface)
+
+};
+
+class NetworkManagerInterface
+        : public TracedInterface
+{
+
     Q_OBJECT
 
     Q_PROPERTY(QDBusObjectPath ActivatingConnection MEMBER ActivatingConnection NOTIFY ActivatingConnectionChanged)
@@ -83,9 +116,9 @@ public :
 
     NetworkManagerInterface(QDBusConnection const & connection,
                             QObject * const parent = Q_NULLPTR)
-        : QDBusAbstractInterface{{NM_DBUS_SERVICE}, {NM_DBUS_PATH}, NM_DBUS_INTERFACE,
-                                 connection,
-                                 parent}
+        : TracedInterface{{NM_DBUS_SERVICE}, {NM_DBUS_PATH}, NM_DBUS_INTERFACE,
+                          connection,
+                          parent}
     {
         qDBusRegisterMetaType< NMObjectPathsList >();
         qDBusRegisterMetaType< NMVariantMapMap >();
@@ -346,6 +379,7 @@ private Q_SLOTS :
 
     void propertyChanged(QString const & propertyName)
     {
+        const TraceScope traceScope{"propertyChanged", propertyName};
         const auto signature = QStringLiteral("%1Changed()").arg(propertyName);
         const int signalIndex = staticMetaObject.indexOfSignal(QMetaObject::normalizedSignature(qUtf8Printable(signature)).constData());
         if (signalIndex < 0) {
@@ -365,6 +399,7 @@ private Q_SLOTS :
 
     void propertiesChanged(QString interfaceName, QVariantMap changedProperties, QStringList invalidatedProperties)
     {
+        const TraceScope traceScope{"PropertiesChanged", interfaceName, path()};
         if (interfaceName != interface()) {
             return;
         }
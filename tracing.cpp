@@ -0,0 +1,161 @@
+#include "tracing.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+Q_LOGGING_CATEGORY(tracingCategory, "tracing")
+
+namespace
+{
+
+QMutex buffersMutex;
+std::vector< std::unique_ptr< Tracer::Buffer > > buffers; // never shrinks, so that buffers outlive their threads until dump()
+
+QMutex dumpMutex;
+
+int signalSockets[2] = {-1, -1};
+
+void onSignal(int signalNumber)
+{
+    const int savedErrno = errno; // only async-signal-safe calls here
+    const char byte = char(signalNumber);
+    const auto written = ::write(signalSockets[0], &byte, sizeof byte); // non-blocking: signals piled up during a dump are dropped instead of stalling the interrupted thread
+    Q_UNUSED(written);
+    errno = savedErrno;
+}
+
+void dumpOnSignals(QString const & fileName) // dedicated thread dumps even if the main thread is stalled
+{
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, signalSockets) != 0) {
+        qCWarning(tracingCategory).noquote()
+                << QCoreApplication::translate("Tracer", "Unable to create socket pair for signal handling, trace is dumped only on exit");
+        return;
+    }
+    if (::fcntl(signalSockets[0], F_SETFL, ::fcntl(signalSockets[0], F_GETFL) | O_NONBLOCK) != 0) {
+        qCWarning(tracingCategory).noquote()
+                << QCoreApplication::translate("Tracer", "Unable to make signal socket non-blocking, trace is dumped only on exit");
+        return;
+    }
+    struct sigaction action = {};
+    action.sa_handler = onSignal;
+    ::sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    ::sigaction(SIGUSR1, &action, Q_NULLPTR);
+    ::sigaction(SIGTERM, &action, Q_NULLPTR);
+    std::thread{[fileName]
+    {
+        char byte = 0;
+        while (::read(signalSockets[1], &byte, sizeof byte) == sizeof byte) {
+            Tracer::dump(fileName);
+            if (byte == SIGTERM) { // watchdog: keep default termination semantics after the trace is saved
+                ::signal(SIGTERM, SIG_DFL);
+                ::kill(::getpid(), SIGTERM);
+                return;
+            }
+        }
+    }}.detach();
+}
+
+}
+
+void Tracer::start()
+{
+    QString fileName = qEnvironmentVariable("NETWORKMANAGER_TRACE");
+    if (fileName.isEmpty()) {
+        fileName = QSettings{}.value("trace").toString();
+    }
+    if (fileName.isEmpty()) {
+        return;
+    }
+    epoch = std::chrono::steady_clock::now();
+    enabled.store(true, std::memory_order_relaxed);
+    qCInfo(tracingCategory).noquote()
+            << QCoreApplication::translate("Tracer", "Tracing is enabled, trace will be written to %1")
+               .arg(fileName);
+    QObject::connect(qApp, &QCoreApplication::aboutToQuit, [fileName]
+    {
+        dump(fileName);
+    });
+    dumpOnSignals(fileName);
+}
+
+Tracer::Buffer * Tracer::registerThread()
+{
+    auto buffer = std::make_unique< Buffer >();
+    const auto thread = QThread::currentThread();
+    buffer->threadName = thread ? thread->objectName() : QString{};
+    QMutexLocker lock{&buffersMutex};
+    buffer->threadId = buffers.size() + 1;
+    if (buffer->threadName.isEmpty()) {
+        buffer->threadName = (thread && (thread == qApp->thread())) ? QStringLiteral("main") : QStringLiteral("thread %1").arg(buffer->threadId);
+    }
+    buffers.push_back(std::move(buffer));
+    return buffers.back().get();
+}
+
+bool Tracer::dump(QString const & fileName)
+{
+    QMutexLocker dumpLock{&dumpMutex}; // signal thread and aboutToQuit may race for the same file
+    const qint64 pid = QCoreApplication::applicationPid();
+    QJsonArray traceEvents;
+    {
+        QMutexLocker lock{&buffersMutex};
+        for (auto const & buffer : buffers) {
+            traceEvents.append(QJsonObject{
+                                   {"ph", QStringLiteral("M")},
+                                   {"name", QStringLiteral("thread_name")},
+                                   {"pid", pid},
+                                   {"tid", qint64(buffer->threadId)},
+                                   {"args", QJsonObject{{"name", buffer->threadName}}},
+                               });
+            const quint64 head = buffer->head.load(std::memory_order_acquire);
+            for (quint64 i = (head > capacity) ? (head - capacity) : 0; i < head; ++i) {
+                Event const & event = buffer->events[i % capacity];
+                const quint64 sequence = event.sequence.load(std::memory_order_acquire);
+                if ((sequence % 2) != 0) { // being written right now
+                    continue;
+                }
+                const qint64 timestamp = event.timestamp;
+                char const * const category = event.category;
+                const char phase = event.phase;
+                std::array< char, sizeof event.name > name;
+                std::memcpy(name.data(), event.name.data(), name.size());
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (event.sequence.load(std::memory_order_relaxed) != sequence) { // overwritten while being read
+                    continue;
+                }
+                traceEvents.append(QJsonObject{
+                                       {"ph", QString{QLatin1Char{phase}}},
+                                       {"cat", QString::fromLatin1(category)},
+                                       {"name", QString::fromUtf8(name.data(), int(qstrnlen(name.data(), uint(name.size()))))},
+                                       {"ts", double(timestamp) / 1000.0}, // microseconds
+                                       {"pid", pid},
+                                       {"tid", qint64(buffer->threadId)},
+                                   });
+            }
+        }
+    }
+    QSaveFile file{fileName};
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(tracingCategory).noquote()
+                << QCoreApplication::translate("Tracer", "Unable to open %1 to write trace: %2")
+                   .arg(fileName, file.errorString());
+        return false;
+    }
+    file.write(QJsonDocument{QJsonObject{{"traceEvents", traceEvents}, {"displayTimeUnit", QStringLiteral("ns")}}}.toJson(QJsonDocument::Compact));
+    if (!file.commit()) {
+        qCWarning(tracingCategory).noquote()
+                << QCoreApplication::translate("Tracer", "Unable to write trace to %1: %2")
+                   .arg(fileName, file.errorString());
+        return false;
+    }
+    return true;
+}
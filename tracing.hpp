@@ -0,0 +1,120 @@
+#pragma once
+
+#include <QtCore>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+
+Q_DECLARE_LOGGING_CATEGORY(tracingCategory)
+
+class Tracer // timeline of begin/end events in per-thread ring buffers, exported as Chrome trace JSON (Perfetto UI opens it too)
+{
+
+public :
+
+    struct Event
+    {
+        std::atomic< quint64 > sequence{0}; // seqlock: odd while the owning thread writes the slot
+        qint64 timestamp; // nanoseconds since start()
+        char const * category; // string literal
+        char phase; // 'B' or 'E'
+        std::array< char, 111 > name; // long enough for an object path and an interface name
+    };
+
+    static constexpr quint64 capacity = 1 << 15; // events per thread, oldest are overwritten
+
+    struct Buffer // single producer (owning thread), the consumer skips slots written concurrently
+    {
+        quint64 threadId = 0;
+        QString threadName;
+        std::atomic< quint64 > head{0};
+        std::array< Event, capacity > events;
+    };
+
+    static bool isEnabled()
+    {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    static void start(); // enables tracing, if NETWORKMANAGER_TRACE environment variable or "trace" setting names an output file; SIGUSR1 dumps on demand, SIGTERM dumps before termination
+    static bool dump(QString const & fileName);
+
+    static void record(char const * category, char phase, char const * name, int size = -1)
+    {
+        thread_local Buffer * buffer = Q_NULLPTR;
+        if (!buffer) {
+            buffer = registerThread();
+        }
+        const quint64 head = buffer->head.load(std::memory_order_relaxed);
+        Event & event = buffer->events[head % capacity];
+        const quint64 sequence = event.sequence.load(std::memory_order_relaxed);
+        event.sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        event.timestamp = std::chrono::duration_cast< std::chrono::nanoseconds >(std::chrono::steady_clock::now() - epoch).count();
+        event.category = category;
+        event.phase = phase;
+        const auto length = size_t(qBound(0, (size < 0) ? int(qstrlen(name)) : size, int(event.name.size()) - 1));
+        std::copy_n(name, length, event.name.begin());
+        event.name[length] = '\0';
+        event.sequence.store(sequence + 2, std::memory_order_release);
+        buffer->head.store(head + 1, std::memory_order_release);
+    }
+
+private :
+
+    static inline std::atomic_bool enabled{false};
+    static inline std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+    static Buffer * registerThread();
+
+};
+
+class TraceScope // emits begin event on construction and matching end event on destruction
+{
+
+public :
+
+    TraceScope(char const * category, char const * name)
+        : category{Tracer::isEnabled() ? category : Q_NULLPTR}
+    {
+        if (this->category) {
+            this->name = QByteArray::fromRawData(name, int(qstrlen(name)));
+            Tracer::record(category, 'B', this->name.constData(), this->name.size());
+        }
+    }
+
+    TraceScope(char const * category, QString const & name)
+        : category{Tracer::isEnabled() ? category : Q_NULLPTR}
+    {
+        if (this->category) {
+            this->name = name.toUtf8();
+            Tracer::record(category, 'B', this->name.constData(), this->name.size());
+        }
+    }
+
+    TraceScope(char const * category, QString const & name, QString const & detail)
+        : category{Tracer::isEnabled() ? category : Q_NULLPTR}
+    {
+        if (this->category) {
+            this->name = (name + QLatin1Char(' ') + detail).toUtf8();
+            Tracer::record(category, 'B', this->name.constData(), this->name.size());
+        }
+    }
+
+    ~TraceScope()
+    {
+        if (category) {
+            Tracer::record(category, 'E', name.constData(), name.size());
+        }
+    }
+
+private :
+
+    Q_DISABLE_COPY(TraceScope)
+
+    char const * const category;
+    QByteArray name;
+
+};